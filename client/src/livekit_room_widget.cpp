@@ -2,16 +2,50 @@
 
 #include <QCoreApplication>
 #include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QUrl>
 #include <QVBoxLayout>
+#include <QWebEngineSettings>
+#include <functional>
+#include "session_trace.h"
+
+namespace {
+
+const QString kBridgePrefix = QStringLiteral("__vagabond:");
+
+// The page talks back to C++ through prefixed console messages so we do not
+// need a QWebChannel just to forward a handful of diagnostics.
+class RoomPage : public QWebEnginePage {
+public:
+    RoomPage(std::function<void(const QString &)> handler, QObject *parent)
+        : QWebEnginePage(parent), bridgeHandler(std::move(handler)) {}
+
+protected:
+    void javaScriptConsoleMessage(JavaScriptConsoleMessageLevel level, const QString &message,
+                                  int lineNumber, const QString &sourceID) override {
+        if (message.startsWith(kBridgePrefix)) {
+            bridgeHandler(message.mid(kBridgePrefix.size()));
+            return;
+        }
+        QWebEnginePage::javaScriptConsoleMessage(level, message, lineNumber, sourceID);
+    }
+
+private:
+    std::function<void(const QString &)> bridgeHandler;
+};
+
+} // namespace
 
 LiveKitRoomWidget::LiveKitRoomWidget(const QString &url, const QString &token, const QString &roomLabel,
-                                     bool startWithAudio, bool startWithVideo, const QString &sdkOverride,
-                                     QWidget *parent)
+                                     bool startWithAudio, bool startWithVideo, bool voiceOnly,
+                                     const QString &sdkOverride, std::uint32_t traceSession, QWidget *parent)
     : QWidget(parent), roomTitle(roomLabel.isEmpty() ? QStringLiteral("Room") : roomLabel),
-      audioEnabled(startWithAudio), videoEnabled(startWithVideo), sdkUrlOverride(sdkOverride) {
+      audioEnabled(startWithAudio), videoEnabled(startWithVideo && !voiceOnly), voiceMode(voiceOnly),
+      sdkUrlOverride(sdkOverride), traceSessionId(traceSession) {
     auto *layout = new QVBoxLayout(this);
     webView = new QWebEngineView(this);
+    webView->setPage(new RoomPage([this](const QString &payload) { handleBridgeMessage(payload); }, webView));
     connect(webView->page(), &QWebEnginePage::featurePermissionRequested,
             this, [this](const QUrl &securityOrigin, QWebEnginePage::Feature feature) {
                 switch (feature) {
@@ -29,6 +63,10 @@ LiveKitRoomWidget::LiveKitRoomWidget(const QString &url, const QString &token, c
                     break;
                 }
             });
+    if (voiceMode) {
+        // The voice gate analyses the mic through an AudioContext, which must not wait for a click.
+        webView->settings()->setAttribute(QWebEngineSettings::PlaybackRequiresUserGesture, false);
+    }
     layout->addWidget(webView);
 
     QString localSdkCandidate;
@@ -38,10 +76,37 @@ LiveKitRoomWidget::LiveKitRoomWidget(const QString &url, const QString &token, c
         localSdkCandidate = QUrl::fromLocalFile(candidateFile.absoluteFilePath()).toString();
     }
 
-    const QString html = buildHtml(url, token, roomTitle, sdkUrlOverride, localSdkCandidate);
+    const QString html = buildHtml(url, token, roomTitle, sdkUrlOverride, localSdkCandidate,
+                                   SessionTrace::isEnabled());
     webView->setHtml(html, QUrl("https://cdn.livekit.io"));
 }
 
+void LiveKitRoomWidget::setTracingEnabled(bool enabled) {
+    webView->page()->runJavaScript(QStringLiteral("window.vagabondSetTracing && window.vagabondSetTracing(%1);")
+                                       .arg(enabled ? QStringLiteral("true") : QStringLiteral("false")));
+}
+
+void LiveKitRoomWidget::setQualityCeiling(int level) {
+    webView->page()->runJavaScript(
+        QStringLiteral("window.vagabondSetQualityCeiling && window.vagabondSetQualityCeiling(%1);").arg(level));
+}
+
+void LiveKitRoomWidget::handleBridgeMessage(const QString &payload) {
+    const QJsonObject message = QJsonDocument::fromJson(payload.toUtf8()).object();
+    const QString type = message.value(QStringLiteral("type")).toString();
+    if (type == QStringLiteral("encoderLoad")) {
+        emit encoderLoadReported(message.value(QStringLiteral("encodeMsPerSec")).toDouble(),
+                                 message.value(QStringLiteral("level")).toInt());
+    } else if (type == QStringLiteral("trace")) {
+        const double start = message.value(QStringLiteral("ts")).toDouble();
+        const double duration = message.value(QStringLiteral("dur")).toDouble();
+        SessionTrace::recordPage(message.value(QStringLiteral("name")).toString(),
+                                 message.value(QStringLiteral("cat")).toString(QStringLiteral("page")),
+                                 SessionTrace::fromEpochMs(start), SessionTrace::fromEpochMs(start + duration),
+                                 roomTitle, traceSessionId);
+    }
+}
+
 QString LiveKitRoomWidget::escapeForJs(const QString &value) const {
     QString escaped = value;
     escaped.replace(QStringLiteral("\\"), QStringLiteral("\\\\"));
@@ -52,7 +117,7 @@ QString LiveKitRoomWidget::escapeForJs(const QString &value) const {
 }
 
 QString LiveKitRoomWidget::buildHtml(const QString &url, const QString &token, const QString &roomLabel,
-                                     const QString &sdkOverride, const QString &localSdkPath) const {
+                                     const QString &sdkOverride, const QString &localSdkPath, bool tracing) const {
     const QString urlJs = escapeForJs(url);
     const QString tokenJs = escapeForJs(token);
     const QString roomLabelJs = escapeForJs(roomLabel);
@@ -69,6 +134,8 @@ QString LiveKitRoomWidget::buildHtml(const QString &url, const QString &token, c
 
     const QString audioDefault = audioEnabled ? QStringLiteral("true") : QStringLiteral("false");
     const QString videoDefault = videoEnabled ? QStringLiteral("true") : QStringLiteral("false");
+    const QString tracingDefault = tracing ? QStringLiteral("true") : QStringLiteral("false");
+    const QString voiceDefault = voiceMode ? QStringLiteral("true") : QStringLiteral("false");
 
     const QString html = QString(R"(<!doctype html>
 <html lang="en">
@@ -97,6 +164,12 @@ QString LiveKitRoomWidget::buildHtml(const QString &url, const QString &token, c
     #chatInputRow { display: flex; gap: 8px; }
     #chatInput { flex: 1; padding: 8px; border-radius: 6px; border: 1px solid #1f3b57; background: #0b1622; color: #d9e2ef; }
     #chatSend { padding: 8px 12px; border-radius: 6px; border: none; background: #2d8cf0; color: white; cursor: pointer; }
+    body.voice .video-only { display: none; }
+    #participants { display: none; flex-wrap: wrap; gap: 8px; padding: 12px; }
+    body.voice #participants { display: flex; }
+    .participant { display: flex; align-items: center; gap: 8px; padding: 6px 10px; border-radius: 6px; background: #12283c; font-size: 13px; }
+    .participant .dot { width: 10px; height: 10px; border-radius: 50%; background: #1f3b57; }
+    .participant.speaking .dot { background: #3ccf6e; box-shadow: 0 0 6px #3ccf6e; }
     #logs { padding: 12px; background: #0f2236; height: 160px; overflow: auto; font-size: 12px; border-top: 1px solid #1f3b57; }
   </style>
 </head>
@@ -111,16 +184,17 @@ QString LiveKitRoomWidget::buildHtml(const QString &url, const QString &token, c
   <div id="controls">
     <button id="reconnect">Reconnect</button>
     <button id="muteAudio">Mute audio</button>
-    <button id="muteVideo">Mute video</button>
-    <button id="screenShare" class="secondary">Share screen</button>
+    <button id="muteVideo" class="video-only">Mute video</button>
+    <button id="screenShare" class="secondary video-only">Share screen</button>
     <label>Microphone
       <select id="micSelect"></select>
     </label>
-    <label>Camera
+    <label class="video-only">Camera
       <select id="camSelect"></select>
     </label>
   </div>
-  <div id="videos"></div>
+  <div id="participants"></div>
+  <div id="videos" class="video-only"></div>
   <div id="chat">
     <div id="chatLog"></div>
     <div id="chatInputRow">
@@ -138,6 +212,26 @@ QString LiveKitRoomWidget::buildHtml(const QString &url, const QString &token, c
     const sdkOverride = '%8';
     const serverBase = '%9';
     const localSdk = '%10';
+    let traceEnabled = %11;
+    const voiceOnly = %12;
+    // Voice channels publish a single mono Opus stream: DTX stops packets during silence and RED
+    // adds redundancy against loss, so a cap well under the default music bitrate is enough.
+    const VOICE_MAX_BITRATE = 24000;
+    const VOICE_GATE_THRESHOLD = 0.01;
+    const VOICE_GATE_HANGOVER_MS = 1500;
+    const SPEAKING_POLL_MS = 250;
+    const SPEAKING_LEVEL = 0.02;
+    // Camera ladder walked by the quality controller; index 0 is the best. The C++ side caps
+    // each tab with a ceiling index so the machine-wide encoder load stays under budget.
+    const QUALITY_LEVELS = [
+      { width: 1280, height: 720, frameRate: 30, maxBitrate: 1700000 },
+      { width: 960, height: 540, frameRate: 24, maxBitrate: 900000 },
+      { width: 640, height: 360, frameRate: 20, maxBitrate: 450000 },
+      { width: 320, height: 180, frameRate: 15, maxBitrate: 150000 }
+    ];
+    const QUALITY_SAMPLE_MS = 2000;
+    const QUALITY_DOWNGRADE_SAMPLES = 2;
+    const QUALITY_UPGRADE_SAMPLES = 5;
     const lkSources = [
       ...(sdkOverride ? [sdkOverride] : []),
       ...(localSdk ? [localSdk] : []),
@@ -161,10 +255,65 @@ QString LiveKitRoomWidget::buildHtml(const QString &url, const QString &token, c
     const chatLog = document.getElementById('chatLog');
     const chatInput = document.getElementById('chatInput');
     const chatSend = document.getElementById('chatSend');
+    const participantsEl = document.getElementById('participants');
+
+    if (voiceOnly) {
+      document.body.classList.add('voice');
+    }
 
     let LK;
     let room;
     let screenSharePub;
+    let voiceGate;
+    let speakingTimer;
+    let manualAudioMute = !startWithAudio;
+    let qualityTimer;
+    let quality = {
+      level: 0, ceiling: 0, trackId: null, last: null, bad: 0, good: 0,
+      originalBitrates: null, originalFramerates: null
+    };
+
+    window.vagabondSetQualityCeiling = ceiling => {
+      quality.ceiling = Math.max(0, Math.min(QUALITY_LEVELS.length - 1, ceiling));
+      if (quality.level < quality.ceiling) {
+        setQualityLevel(quality.ceiling, 'encoder budget');
+      }
+    };
+
+    window.vagabondSetTracing = enabled => { traceEnabled = enabled; };
+
+    function traceNow() {
+      return performance.timeOrigin + performance.now();
+    }
+
+    function emitSpan(name, cat, start, end) {
+      console.debug('__vagabond:' + JSON.stringify({ type: 'trace', name, cat, ts: start, dur: end - start }));
+    }
+
+    async function traced(name, cat, fn) {
+      if (!traceEnabled) return fn();
+      const start = traceNow();
+      try {
+        return await fn();
+      } finally {
+        emitSpan(name, cat, start, traceNow());
+      }
+    }
+
+    function traceResourceTiming(src) {
+      if (!traceEnabled) return;
+      const entry = performance.getEntriesByName(src).pop();
+      if (!entry) return;
+      const origin = performance.timeOrigin;
+      // Cross-origin entries without Timing-Allow-Origin report zeros for these phases.
+      if (entry.domainLookupEnd > entry.domainLookupStart) {
+        emitSpan('sdk.dns', 'network', origin + entry.domainLookupStart, origin + entry.domainLookupEnd);
+      }
+      if (entry.connectEnd > entry.connectStart) {
+        emitSpan('sdk.tcp+tls', 'network', origin + entry.connectStart, origin + entry.connectEnd);
+      }
+      emitSpan('sdk.fetch', 'network', origin + entry.startTime, origin + entry.responseEnd);
+    }
 
     function resolveLiveKitGlobal() {
       const lk = window.LiveKit || window.LiveKitClient || window.LivekitClient || window.livekit || window.livekitClient;
@@ -192,6 +341,7 @@ QString LiveKitRoomWidget::buildHtml(const QString &url, const QString &token, c
         script.src = src;
         script.async = true;
         script.onload = async () => {
+          traceResourceTiming(src);
           LK = resolveLiveKitGlobal();
           if (LK) {
             if (!window.LiveKit) {
@@ -232,7 +382,7 @@ QString LiveKitRoomWidget::buildHtml(const QString &url, const QString &token, c
     async function loadScriptSequential(sources) {
       for (const src of sources) {
         try {
-          const loaded = await loadFromSource(src);
+          const loaded = await traced('sdk.source ' + src, 'sdk', () => loadFromSource(src));
           if (loaded) return loaded;
         } catch (err) {
           // Continue to next source
@@ -243,7 +393,7 @@ QString LiveKitRoomWidget::buildHtml(const QString &url, const QString &token, c
 
     async function ensureLiveKit() {
       if (LK) return LK;
-      return loadScriptSequential(lkSources);
+      return traced('sdk.load', 'sdk', () => loadScriptSequential(lkSources));
     }
 
     function log(line) {
@@ -273,6 +423,10 @@ QString LiveKitRoomWidget::buildHtml(const QString &url, const QString &token, c
     }
 
     function attachTrack(publication) {
+      if (voiceOnly) {
+        if (publication.kind !== 'audio') return;
+        if (!publication.isSubscribed) publication.setSubscribed(true);
+      }
       publication.on('subscribed', track => {
         log('Track subscribed: ' + track.sid + ' (' + track.kind + ')');
         if (track.kind === 'video') {
@@ -286,7 +440,7 @@ QString LiveKitRoomWidget::buildHtml(const QString &url, const QString &token, c
     async function populateDevices() {
       const devices = await navigator.mediaDevices.enumerateDevices();
       const mics = devices.filter(d => d.kind === 'audioinput');
-      const cams = devices.filter(d => d.kind === 'videoinput');
+      const cams = voiceOnly ? [] : devices.filter(d => d.kind === 'videoinput');
       micSelect.innerHTML = '';
       camSelect.innerHTML = '';
       mics.forEach(d => {
@@ -303,9 +457,244 @@ QString LiveKitRoomWidget::buildHtml(const QString &url, const QString &token, c
       });
     }
 
+    function audioCaptureOptions(deviceId) {
+      const constraint = deviceId ? { deviceId: { exact: deviceId } } : {};
+      if (voiceOnly) {
+        Object.assign(constraint, { channelCount: 1, echoCancellation: true, noiseSuppression: true, autoGainControl: true });
+      }
+      return Object.keys(constraint).length ? constraint : true;
+    }
+
+    function publishOptions(kind) {
+      if (voiceOnly && kind === 'audio') {
+        return { dtx: true, red: true, forceStereo: false, audioPreset: { maxBitrate: VOICE_MAX_BITRATE } };
+      }
+      return undefined;
+    }
+
+    // LocalTrackPublication.mute()/unmute() stop sending and signal the server; mic capture keeps
+    // running (stopMicTrackOnMute is off), so the voice gate's cloned probe still hears speech.
+    async function setAudioMuted(pub, muted) {
+      try {
+        if (muted) {
+          await pub.mute();
+        } else {
+          await pub.unmute();
+        }
+      } catch (err) {
+        log('Could not ' + (muted ? 'mute' : 'unmute') + ' microphone: ' + err);
+      }
+    }
+
+    function stopVoiceGate() {
+      if (!voiceGate) return;
+      clearInterval(voiceGate.timer);
+      voiceGate.probe.stop();
+      voiceGate.context.close();
+      voiceGate = undefined;
+    }
+
+    // Watches a clone of the mic track (the published one goes silent once muted) and mutes the
+    // publication after a short hangover of silence, unmuting as soon as speech comes back.
+    function startVoiceGate(track, pub) {
+      stopVoiceGate();
+      const probe = track.mediaStreamTrack.clone();
+      const context = new AudioContext();
+      context.resume();
+      const analyser = context.createAnalyser();
+      analyser.fftSize = 512;
+      context.createMediaStreamSource(new MediaStream([probe])).connect(analyser);
+      const samples = new Float32Array(analyser.fftSize);
+      let lastVoiceAt = performance.now();
+      const gate = { probe, context, level: 0, gated: false, busy: false };
+      gate.timer = setInterval(() => {
+        analyser.getFloatTimeDomainData(samples);
+        let sum = 0;
+        for (let i = 0; i < samples.length; i++) sum += samples[i] * samples[i];
+        gate.level = Math.sqrt(sum / samples.length);
+        const now = performance.now();
+        if (gate.level > VOICE_GATE_THRESHOLD) lastVoiceAt = now;
+        if (manualAudioMute || gate.busy) return;
+        const silent = now - lastVoiceAt > VOICE_GATE_HANGOVER_MS;
+        if (silent !== gate.gated) {
+          gate.gated = silent;
+          gate.busy = true;
+          setAudioMuted(pub, silent).finally(() => { gate.busy = false; });
+        }
+      }, 100);
+      voiceGate = gate;
+    }
+
+    function renderParticipants() {
+      if (!voiceOnly || !room) return;
+      participantsEl.textContent = '';
+      [room.localParticipant, ...room.participants.values()].forEach(p => {
+        const row = document.createElement('div');
+        row.className = 'participant';
+        row.dataset.identity = p.identity;
+        const dot = document.createElement('span');
+        dot.className = 'dot';
+        const name = document.createElement('span');
+        name.textContent = p === room.localParticipant ? p.identity + ' (you)' : p.identity;
+        row.appendChild(dot);
+        row.appendChild(name);
+        participantsEl.appendChild(row);
+      });
+    }
+
+    function cameraPublication() {
+      if (!room) return undefined;
+      return [...room.localParticipant.videoTracks.values()].find(p => p.source === 'camera' && p.track);
+    }
+
+    async function applyQualityLevel(pub) {
+      const level = QUALITY_LEVELS[quality.level];
+      const track = pub.track;
+      try {
+        await track.mediaStreamTrack.applyConstraints({
+          width: { ideal: level.width },
+          height: { ideal: level.height },
+          frameRate: { ideal: level.frameRate }
+        });
+        const sender = track.sender;
+        if (!sender) return;
+        const params = sender.getParameters();
+        if (!params.encodings || params.encodings.length === 0) return;
+        if (!quality.originalBitrates) {
+          quality.originalBitrates = params.encodings.map(e => e.maxBitrate);
+          quality.originalFramerates = params.encodings.map(e => e.maxFramerate);
+        }
+        // Scale every simulcast layer by the same factor so the ladder caps the top layer and
+        // the lower layers keep their relative spacing instead of all collapsing onto one cap.
+        const topBitrate = Math.max(0, ...quality.originalBitrates.filter(b => b > 0));
+        const scale = topBitrate > 0 ? Math.min(1, level.maxBitrate / topBitrate) : 1;
+        params.encodings.forEach((enc, i) => {
+          const originalBitrate = quality.originalBitrates[i];
+          enc.maxBitrate = originalBitrate > 0 ? Math.round(originalBitrate * scale) : level.maxBitrate;
+          const originalFramerate = quality.originalFramerates[i];
+          enc.maxFramerate = originalFramerate > 0 ? Math.min(originalFramerate, level.frameRate) : level.frameRate;
+        });
+        await sender.setParameters(params);
+      } catch (err) {
+        log('Could not apply camera quality: ' + err);
+      }
+    }
+
+    function setQualityLevel(level, reason) {
+      const next = Math.max(quality.ceiling, Math.min(QUALITY_LEVELS.length - 1, level));
+      if (next === quality.level) return;
+      quality.level = next;
+      quality.bad = 0;
+      quality.good = 0;
+      const pub = cameraPublication();
+      if (pub) applyQualityLevel(pub);
+      const l = QUALITY_LEVELS[next];
+      log('Camera quality ' + l.height + 'p' + l.frameRate + ' (' + reason + ')');
+    }
+
+    async function sampleCameraQuality() {
+      const pub = cameraPublication();
+      if (!pub || pub.isMuted || !pub.track.sender) {
+        quality.last = null;
+        console.debug('__vagabond:' + JSON.stringify({ type: 'encoderLoad', encodeMsPerSec: 0, level: quality.level }));
+        return;
+      }
+      if (pub.track.mediaStreamTrack.id !== quality.trackId) {
+        // New capture (first publish or device switch) starts at full quality; re-apply our step.
+        quality.trackId = pub.track.mediaStreamTrack.id;
+        quality.originalBitrates = null;
+        quality.originalFramerates = null;
+        quality.last = null;
+        await applyQualityLevel(pub);
+      }
+
+      const report = await pub.track.sender.getStats();
+      let encodeTime = 0;
+      let framesEncoded = 0;
+      let limitation = 'none';
+      let availableBitrate = 0;
+      report.forEach(stat => {
+        if (stat.type === 'outbound-rtp' && stat.kind === 'video') {
+          encodeTime += stat.totalEncodeTime || 0;
+          framesEncoded += stat.framesEncoded || 0;
+          if (stat.qualityLimitationReason && stat.qualityLimitationReason !== 'none') {
+            limitation = stat.qualityLimitationReason;
+          }
+        } else if (stat.type === 'candidate-pair' && stat.nominated && stat.availableOutgoingBitrate) {
+          availableBitrate = stat.availableOutgoingBitrate;
+        }
+      });
+
+      const now = performance.now();
+      const last = quality.last;
+      quality.last = { now, encodeTime, framesEncoded };
+      if (!last || framesEncoded <= last.framesEncoded) return;
+
+      const encodeMs = (encodeTime - last.encodeTime) * 1000;
+      const encodeMsPerSec = encodeMs / ((now - last.now) / 1000);
+      const encodeMsPerFrame = encodeMs / (framesEncoded - last.framesEncoded);
+      console.debug('__vagabond:' + JSON.stringify({ type: 'encoderLoad', encodeMsPerSec, level: quality.level }));
+
+      const current = QUALITY_LEVELS[quality.level];
+      const frameBudgetMs = 1000 / current.frameRate;
+      // Only the encoder's own limitation report and encode time trigger a step down: a low
+      // bandwidth estimate alone is normal for low-motion scenes that never fill the cap.
+      const constrained = limitation === 'cpu' || limitation === 'bandwidth' ||
+        encodeMsPerFrame > frameBudgetMs * 0.5;
+      // The estimator only probes up to our configured cap, so reaching the current cap is
+      // the strongest bandwidth signal available for stepping back up.
+      const headroom = quality.level > 0 && limitation === 'none' &&
+        (availableBitrate === 0 || availableBitrate >= current.maxBitrate) &&
+        encodeMsPerFrame < frameBudgetMs * 0.25;
+
+      // Step down quickly, step up slowly so we do not oscillate around a limit.
+      if (constrained) {
+        quality.good = 0;
+        if (++quality.bad >= QUALITY_DOWNGRADE_SAMPLES) {
+          setQualityLevel(quality.level + 1, limitation !== 'none' ? limitation + ' limited' : 'encoder load');
+        }
+      } else if (headroom && quality.level > quality.ceiling) {
+        quality.bad = 0;
+        if (++quality.good >= QUALITY_UPGRADE_SAMPLES) {
+          setQualityLevel(quality.level - 1, 'headroom');
+        }
+      } else {
+        quality.bad = 0;
+        quality.good = 0;
+      }
+    }
+
+    function startQualityController() {
+      clearInterval(qualityTimer);
+      if (voiceOnly) return;
+      quality = {
+        ...quality, level: quality.ceiling, trackId: null, last: null, bad: 0, good: 0,
+        originalBitrates: null, originalFramerates: null
+      };
+      qualityTimer = setInterval(() => {
+        sampleCameraQuality().catch(err => log('Quality sample failed: ' + err));
+      }, QUALITY_SAMPLE_MS);
+    }
+
+    function startSpeakingIndicators() {
+      clearInterval(speakingTimer);
+      if (!voiceOnly) return;
+      renderParticipants();
+      speakingTimer = setInterval(() => {
+        if (!room) return;
+        const levels = new Map();
+        room.participants.forEach(p => levels.set(p.identity, p.audioLevel || 0));
+        const localLevel = voiceGate && !manualAudioMute ? voiceGate.level : 0;
+        levels.set(room.localParticipant.identity, localLevel);
+        participantsEl.querySelectorAll('.participant').forEach(row => {
+          row.classList.toggle('speaking', (levels.get(row.dataset.identity) || 0) > SPEAKING_LEVEL);
+        });
+      }, SPEAKING_POLL_MS);
+    }
+
     async function replaceTrack(kind, deviceId) {
       if (!room) return;
-      const constraints = kind === 'audio' ? { audio: { deviceId: { exact: deviceId } }, video: false }
+      const constraints = kind === 'audio' ? { audio: audioCaptureOptions(deviceId), video: false }
                                            : { audio: false, video: { deviceId: { exact: deviceId } } };
       const tracks = await LK.createLocalTracks(constraints);
       const newTrack = tracks.find(t => t.kind === kind);
@@ -319,10 +708,14 @@ QString LiveKitRoomWidget::buildHtml(const QString &url, const QString &token, c
         }
       });
 
-      await room.localParticipant.publishTrack(newTrack);
+      const pub = await room.localParticipant.publishTrack(newTrack, publishOptions(kind));
       if (kind === 'video') {
         addVideoElement(newTrack, true, true);
       }
+      if (kind === 'audio' && voiceOnly) {
+        if (manualAudioMute) await setAudioMuted(pub, true);
+        startVoiceGate(newTrack, pub);
+      }
       log('Switched ' + kind + ' device');
     }
 
@@ -357,19 +750,28 @@ QString LiveKitRoomWidget::buildHtml(const QString &url, const QString &token, c
     }
 
     async function connectRoom() {
+      return traced('join', 'join', joinRoom);
+    }
+
+    async function joinRoom() {
       if (room) {
         try { await room.disconnect(); } catch (e) {}
       }
+      stopVoiceGate();
+      clearInterval(speakingTimer);
+      clearInterval(qualityTimer);
+      participantsEl.textContent = '';
       status.textContent = 'Connecting…';
       logs.textContent = '';
       videos.textContent = '';
       chatLog.textContent = '';
       try {
-        await populateDevices();
-        const audioConstraint = micSelect.value ? { deviceId: { exact: micSelect.value } } : true;
-        const videoConstraint = camSelect.value ? { deviceId: { exact: camSelect.value } } : true;
+        await traced('devices.enumerate', 'media', populateDevices);
+        const audioConstraint = audioCaptureOptions(micSelect.value);
+        const videoConstraint = voiceOnly ? false : (camSelect.value ? { deviceId: { exact: camSelect.value } } : true);
         const LK = await ensureLiveKit();
-        room = await LK.connect(url, token, { autoSubscribe: true });
+        // Voice channels subscribe to audio publications explicitly so remote video is never decoded.
+        room = await traced('room.connect', 'signal', () => LK.connect(url, token, { autoSubscribe: !voiceOnly }));
         window.room = room;
         status.textContent = 'Connected as ' + room.localParticipant.identity;
         log('Connected to ' + roomLabel);
@@ -377,9 +779,11 @@ QString LiveKitRoomWidget::buildHtml(const QString &url, const QString &token, c
         muteAudioBtn.textContent = startWithAudio ? 'Mute audio' : 'Unmute audio';
         muteVideoBtn.textContent = startWithVideo ? 'Mute video' : 'Unmute video';
 
-        const localTracks = await LK.createLocalTracks({ audio: audioConstraint, video: videoConstraint });
+        const localTracks = await traced('tracks.create', 'media',
+          () => LK.createLocalTracks({ audio: audioConstraint, video: videoConstraint }));
         for (const t of localTracks) {
-          const pub = await room.localParticipant.publishTrack(t);
+          const pub = await traced('track.publish ' + t.kind, 'media',
+            () => room.localParticipant.publishTrack(t, publishOptions(t.kind)));
           if (t.kind === 'video') {
             addVideoElement(t, true, true);
             if (!startWithVideo) {
@@ -387,7 +791,10 @@ QString LiveKitRoomWidget::buildHtml(const QString &url, const QString &token, c
             }
           }
           if (t.kind === 'audio' && !startWithAudio) {
-            await pub.setMuted(true);
+            await setAudioMuted(pub, true);
+          }
+          if (t.kind === 'audio' && voiceOnly) {
+            startVoiceGate(t, pub);
           }
         }
 
@@ -396,8 +803,17 @@ QString LiveKitRoomWidget::buildHtml(const QString &url, const QString &token, c
           p.on('trackPublished', attachTrack);
         });
 
-        room.on('participantConnected', p => log(p.identity + ' joined'));
-        room.on('participantDisconnected', p => log(p.identity + ' left'));
+        room.on('participantConnected', p => {
+          log(p.identity + ' joined');
+          p.on('trackPublished', attachTrack);
+          renderParticipants();
+        });
+        room.on('participantDisconnected', p => {
+          log(p.identity + ' left');
+          renderParticipants();
+        });
+        startSpeakingIndicators();
+        startQualityController();
         room.on('disconnected', () => status.textContent = 'Disconnected');
         room.on('dataReceived', (payload, participant, kind, topic) => {
           const decoder = new TextDecoder();
@@ -408,8 +824,10 @@ QString LiveKitRoomWidget::buildHtml(const QString &url, const QString &token, c
         muteAudioBtn.onclick = () => {
           const pubs = [...room.localParticipant.audioTracks.values()];
           if (pubs.length === 0) return;
-          const nextMuted = !pubs.every(p => p.isMuted);
-          pubs.forEach(p => p.setMuted(nextMuted));
+          const nextMuted = voiceOnly ? !manualAudioMute : !pubs.every(p => p.isMuted);
+          manualAudioMute = nextMuted;
+          if (voiceGate) voiceGate.gated = false;
+          pubs.forEach(p => setAudioMuted(p, nextMuted));
           muteAudioBtn.textContent = nextMuted ? 'Unmute audio' : 'Mute audio';
         };
 
@@ -453,7 +871,7 @@ QString LiveKitRoomWidget::buildHtml(const QString &url, const QString &token, c
 </body>
 </html>
 )").arg(urlJs, roomLabelJs, urlJs, tokenJs, roomLabelJs, audioDefault, videoDefault, sdkOverrideJs,
-        serverBaseJs, localSdkJs);
+        serverBaseJs, localSdkJs, tracingDefault, voiceDefault);
 
     return html;
 }
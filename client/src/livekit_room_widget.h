@@ -3,24 +3,36 @@
 #include <QWidget>
 #include <QWebEngineView>
 #include <QWebEnginePage>
+#include <cstdint>
 
 class LiveKitRoomWidget : public QWidget {
     Q_OBJECT
 public:
     explicit LiveKitRoomWidget(const QString &url, const QString &token, const QString &roomLabel,
-                               bool startWithAudio, bool startWithVideo, const QString &sdkOverride,
+                               bool startWithAudio, bool startWithVideo, bool voiceOnly,
+                               const QString &sdkOverride, std::uint32_t traceSession = 0,
                                QWidget *parent = nullptr);
 
     QString title() const { return roomTitle; }
+    bool isVoiceOnly() const { return voiceMode; }
+    void setTracingEnabled(bool enabled);
+    // Lowest camera quality index (0 = best) the page may use; set by the encoder budget.
+    void setQualityCeiling(int level);
+
+signals:
+    void encoderLoadReported(double encodeMsPerSec, int level);
 
 private:
+    void handleBridgeMessage(const QString &payload);
     QString buildHtml(const QString &url, const QString &token, const QString &roomLabel,
-                      const QString &sdkOverride, const QString &localSdkPath) const;
+                      const QString &sdkOverride, const QString &localSdkPath, bool tracing) const;
     QString escapeForJs(const QString &value) const;
 
     QString roomTitle;
     QWebEngineView *webView {nullptr};
     bool audioEnabled {true};
     bool videoEnabled {true};
+    bool voiceMode {false};
     QString sdkUrlOverride;
+    std::uint32_t traceSessionId {0};
 };
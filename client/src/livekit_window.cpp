@@ -1,6 +1,9 @@
 #include "livekit_window.h"
 
 #include <QApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QFileDialog>
 #include <QHBoxLayout>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -8,7 +11,41 @@
 #include <QNetworkRequest>
 #include <QVBoxLayout>
 #include <QWidget>
+#include <algorithm>
+#include <utility>
 #include "livekit_room_widget.h"
+#include "session_trace.h"
+
+namespace {
+
+// Matches the last entry of QUALITY_LEVELS in the room page.
+constexpr int kLowestQualityLevel = 3;
+constexpr qint64 kRebalanceIntervalMs = 4000;
+
+// A hung or overloaded auth server must not leave the form disabled forever. The transfer
+// timeout catches a silent server; the per-attempt deadline catches one that drips bytes.
+constexpr int kAuthTimeoutMs = 10000;
+constexpr int kAuthMaxAttempts = 3;
+constexpr int kAuthRetryBaseDelayMs = 500;
+constexpr qint64 kMaxAuthResponseBytes = 1024 * 1024;
+
+bool isRetryableAuthError(QNetworkReply *reply) {
+    switch (reply->error()) {
+    case QNetworkReply::OperationCanceledError: // transfer timeout
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::ProxyTimeoutError:
+        return true;
+    default:
+        break;
+    }
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    return status == 502 || status == 503 || status == 504;
+}
+
+} // namespace
 
 LiveKitWindow::LiveKitWindow(QWidget *parent) : QMainWindow(parent) {
     auto *central = new QWidget(this);
@@ -17,6 +54,7 @@ LiveKitWindow::LiveKitWindow(QWidget *parent) : QMainWindow(parent) {
     auto *authLayout = new QHBoxLayout();
     const QString defaultAuthUrl = QString::fromUtf8(qgetenv("LIVEKIT_AUTH_URL"));
     authUrlInput = new QLineEdit(this);
+    authUrlInput->setObjectName(QStringLiteral("authUrlInput"));
     authUrlInput->setPlaceholderText(QStringLiteral("Auth URL"));
     authUrlInput->setText(defaultAuthUrl.isEmpty() ? QStringLiteral("https://livekit.vagabovnr.moscow/api/token")
                                                    : defaultAuthUrl);
@@ -30,16 +68,32 @@ LiveKitWindow::LiveKitWindow(QWidget *parent) : QMainWindow(parent) {
     passwordInput->setEchoMode(QLineEdit::Password);
     passwordInput->setText(QStringLiteral("test"));
     roomInput = new QLineEdit(this);
+    roomInput->setObjectName(QStringLiteral("roomInput"));
     roomInput->setPlaceholderText(QStringLiteral("Room label"));
     roomInput->setText(QStringLiteral("general"));
     connectButton = new QPushButton(tr("Sign in & join"), this);
     statusLabel = new QLabel(tr("Enter login, password and room"), this);
+    statusLabel->setObjectName(QStringLiteral("statusLabel"));
     accountLabel = new QLabel(tr("Not signed in"), this);
 
     audioCheck = new QCheckBox(tr("Join with microphone on"), this);
     audioCheck->setChecked(true);
     videoCheck = new QCheckBox(tr("Join with camera on"), this);
     videoCheck->setChecked(true);
+    voiceCheck = new QCheckBox(tr("Voice channel (audio only)"), this);
+
+    SessionTrace::setEnabled(qEnvironmentVariableIntValue("VAGABOND_TRACE") != 0);
+    traceCheck = new QCheckBox(tr("Record join trace"), this);
+    traceCheck->setChecked(SessionTrace::isEnabled());
+    exportTraceButton = new QPushButton(tr("Export trace…"), this);
+
+    // Encode milliseconds per wall-clock second summed over every open camera, i.e. roughly
+    // the share of one core all tabs together may spend encoding video.
+    bool budgetOk = false;
+    const double budgetFromEnv = qEnvironmentVariable("VAGABOND_ENCODE_BUDGET_MS").toDouble(&budgetOk);
+    if (budgetOk && budgetFromEnv > 0) {
+        encodeBudgetMs = budgetFromEnv;
+    }
 
     authLayout->addWidget(new QLabel(tr("Auth URL"), this));
     authLayout->addWidget(authUrlInput, 3);
@@ -54,6 +108,8 @@ LiveKitWindow::LiveKitWindow(QWidget *parent) : QMainWindow(parent) {
     auto *sdkLayout = new QHBoxLayout();
     sdkLayout->addWidget(new QLabel(tr("SDK URL override"), this));
     sdkLayout->addWidget(sdkUrlInput, 1);
+    sdkLayout->addWidget(traceCheck);
+    sdkLayout->addWidget(exportTraceButton);
 
     tabWidget = new QTabWidget(this);
     tabWidget->setTabsClosable(true);
@@ -64,6 +120,7 @@ LiveKitWindow::LiveKitWindow(QWidget *parent) : QMainWindow(parent) {
     layout->addLayout(sdkLayout);
     layout->addWidget(audioCheck);
     layout->addWidget(videoCheck);
+    layout->addWidget(voiceCheck);
     layout->addWidget(tabWidget, 1);
 
     setCentralWidget(central);
@@ -72,10 +129,34 @@ LiveKitWindow::LiveKitWindow(QWidget *parent) : QMainWindow(parent) {
 
     connect(connectButton, &QPushButton::clicked, this, &LiveKitWindow::connectToLiveKit);
     connect(tabWidget, &QTabWidget::tabCloseRequested, this, &LiveKitWindow::closeTab);
+    connect(voiceCheck, &QCheckBox::toggled, videoCheck, [this](bool voiceOnly) {
+        videoCheck->setEnabled(!voiceOnly);
+    });
+    connect(traceCheck, &QCheckBox::toggled, this, &LiveKitWindow::setTracingEnabled);
+    connect(exportTraceButton, &QPushButton::clicked, this, &LiveKitWindow::exportTrace);
+
+    authTimeoutMs = qEnvironmentVariableIntValue("VAGABOND_AUTH_TIMEOUT_MS");
+    if (authTimeoutMs <= 0) {
+        authTimeoutMs = kAuthTimeoutMs;
+    }
+    authDeadlineMs = authTimeoutMs * 3 / 2;
+
+    authRetryTimer.setSingleShot(true);
+    connect(&authRetryTimer, &QTimer::timeout, this, &LiveKitWindow::sendAuthRequest);
+    authDeadlineTimer.setSingleShot(true);
+    connect(&authDeadlineTimer, &QTimer::timeout, this, [this]() {
+        if (!pendingAuthReply) return;
+        authReplyTimedOut = true;
+        pendingAuthReply->abort();
+    });
 }
 
 void LiveKitWindow::connectToLiveKit() {
+    authRetryTimer.stop();
+    authDeadlineTimer.stop();
     if (pendingAuthReply) {
+        disconnect(pendingAuthReply, nullptr, this, nullptr);
+        pendingAuthReply->abort();
         pendingAuthReply->deleteLater();
         pendingAuthReply = nullptr;
     }
@@ -111,14 +192,35 @@ void LiveKitWindow::connectToLiveKit() {
 
     QNetworkRequest request(endpoint);
     request.setHeader(QNetworkRequest::ContentTypeHeader, QStringLiteral("application/json"));
+    request.setTransferTimeout(authTimeoutMs);
 
     setFormEnabled(false);
-        statusLabel->setText(tr("Requesting LiveKit token…"));
+    statusLabel->setText(tr("Requesting LiveKit token…"));
     appendLog(tr("Contacting %1").arg(endpoint.toString()));
-    pendingAuthReply = network.post(request, QJsonDocument(payload).toJson());
+    pendingRoom = room;
+    pendingTraceSession = SessionTrace::newSession();
+    pendingAuthRequest = request;
+    pendingAuthPayload = QJsonDocument(payload).toJson();
+    authAttempt = 0;
     lastIdentity = identity;
+    sendAuthRequest();
+}
+
+void LiveKitWindow::sendAuthRequest() {
+    ++authAttempt;
+    authReplyOversized = false;
+    authReplyTimedOut = false;
+    authStartNs = SessionTrace::isEnabled() ? SessionTrace::nowNs() : 0;
+    pendingAuthReply = network.post(pendingAuthRequest, pendingAuthPayload);
 
     connect(pendingAuthReply, &QNetworkReply::finished, this, &LiveKitWindow::handleAuthResponse);
+    connect(pendingAuthReply, &QNetworkReply::downloadProgress, this, [this](qint64 received, qint64) {
+        if (received > kMaxAuthResponseBytes && pendingAuthReply) {
+            authReplyOversized = true;
+            pendingAuthReply->abort();
+        }
+    });
+    authDeadlineTimer.start(authDeadlineMs);
 }
 
 void LiveKitWindow::handleAuthResponse() {
@@ -129,14 +231,48 @@ void LiveKitWindow::handleAuthResponse() {
     if (reply == pendingAuthReply) {
         pendingAuthReply = nullptr;
     }
+    authDeadlineTimer.stop();
+
+    if (authStartNs) {
+        SessionTrace::record("auth.request", "auth", authStartNs, SessionTrace::nowNs(), pendingRoom,
+                             pendingTraceSession);
+        authStartNs = 0;
+    }
+    if (reply->error() != QNetworkReply::NoError && !authReplyOversized && authAttempt < kAuthMaxAttempts
+        && isRetryableAuthError(reply)) {
+        const int delayMs = kAuthRetryBaseDelayMs * authAttempt;
+        appendLog(tr("Auth attempt %1 failed (%2), retrying in %3 ms")
+                      .arg(authAttempt)
+                      .arg(reply->errorString())
+                      .arg(delayMs));
+        authRetryTimer.start(delayMs);
+        return;
+    }
+
+    // Only the attempt whose response is actually handled gets an auth.handle span.
+    SessionTrace::Span handleSpan("auth.handle", "auth", pendingRoom, pendingTraceSession);
 
     setFormEnabled(true);
+    if (!queuedLaunchRoom.isEmpty()) {
+        QTimer::singleShot(0, this, &LiveKitWindow::openQueuedLaunchRoom);
+    }
+
+    if (authReplyOversized) {
+        appendLog(tr("Auth failed: response exceeded %1 KiB").arg(kMaxAuthResponseBytes / 1024));
+        emit authFinished(false);
+        return;
+    }
 
     const QByteArray data = reply->readAll();
 
     if (reply->error() != QNetworkReply::NoError) {
         const QVariant status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
         QString errorText = reply->errorString();
+        if (authReplyTimedOut) {
+            errorText = tr("response not complete within %1 ms").arg(authDeadlineMs);
+        } else if (reply->error() == QNetworkReply::OperationCanceledError) {
+            errorText = tr("no data received for %1 ms").arg(authTimeoutMs);
+        }
         if (status.isValid()) {
             errorText = tr("HTTP %1: %2").arg(status.toInt()).arg(errorText);
         }
@@ -148,11 +284,13 @@ void LiveKitWindow::handleAuthResponse() {
 
         statusLabel->setText(tr("Auth failed: %1").arg(errorText));
         appendLog(tr("Auth failed: %1").arg(errorText));
+        emit authFinished(false);
         return;
     }
     const QJsonDocument doc = QJsonDocument::fromJson(data);
     if (!doc.isObject()) {
         statusLabel->setText(tr("Unexpected response from server"));
+        emit authFinished(false);
         return;
     }
 
@@ -174,22 +312,107 @@ void LiveKitWindow::handleAuthResponse() {
     if (token.isEmpty()) {
         statusLabel->setText(tr("Server did not return a LiveKit token"));
         appendLog(tr("Missing token in response"));
+        emit authFinished(false);
         return;
     }
 
     accountLabel->setText(tr("Signed in as %1").arg(lastIdentity));
     appendLog(tr("Opening LiveKit room %1").arg(room));
-    openRoomTab(url, token, room, audioCheck->isChecked(), videoCheck->isChecked());
+    emit roomTokenReceived(url, token, room);
+    if (opensRoomTabs) {
+        openRoomTab(url, token, room, audioCheck->isChecked(), videoCheck->isChecked(), voiceCheck->isChecked());
+    }
+    emit authFinished(true);
+}
+
+void LiveKitWindow::handleLaunchRequest(const QStringList &arguments, double sentAtMs) {
+    double forwardLatencyMs = 0;
+    if (sentAtMs > 0) {
+        const double nowMs = static_cast<double>(QDateTime::currentMSecsSinceEpoch());
+        forwardLatencyMs = nowMs - sentAtMs;
+        SessionTrace::record("instance.forward", "launch", SessionTrace::fromEpochMs(sentAtMs),
+                             SessionTrace::fromEpochMs(nowMs));
+        appendLog(tr("Launch forwarded from a second instance in %1 ms").arg(forwardLatencyMs, 0, 'f', 0));
+
+        if (isMinimized()) {
+            showNormal();
+        }
+        raise();
+        activateWindow();
+    }
+    emit launchRequestHandled(forwardLatencyMs);
+
+    QString room;
+    for (const QString &argument : arguments) {
+        const QUrl link(argument);
+        if (link.scheme() == QStringLiteral("vagabond") && link.host() == QStringLiteral("room")) {
+            room = link.path(QUrl::FullyDecoded).section(QLatin1Char('/'), 1, 1).trimmed();
+            break;
+        }
+    }
+    if (room.isEmpty()) return;
+
+    if (pendingAuthReply || authRetryTimer.isActive()) {
+        // Never cancel a sign-in the user started; join the linked room once it settles.
+        queuedLaunchRoom = room;
+        appendLog(tr("Room link %1 will open after the current sign-in finishes").arg(room));
+        return;
+    }
+    openRoomLink(room);
+}
+
+void LiveKitWindow::openQueuedLaunchRoom() {
+    if (queuedLaunchRoom.isEmpty() || pendingAuthReply || authRetryTimer.isActive()) return;
+    openRoomLink(std::exchange(queuedLaunchRoom, QString()));
+}
+
+void LiveKitWindow::openRoomLink(const QString &room) {
+    for (int i = 0; i < tabWidget->count(); ++i) {
+        auto *roomWidget = qobject_cast<LiveKitRoomWidget *>(tabWidget->widget(i));
+        if (roomWidget && roomWidget->title() == room) {
+            tabWidget->setCurrentIndex(i);
+            appendLog(tr("Switched to room %1").arg(room));
+            return;
+        }
+    }
+
+    roomInput->setText(room);
+    connectToLiveKit();
 }
 
 void LiveKitWindow::closeTab(int index) {
     QWidget *widget = tabWidget->widget(index);
+    encoderLoads.remove(qobject_cast<LiveKitRoomWidget *>(widget));
     tabWidget->removeTab(index);
     widget->deleteLater();
     statusLabel->setText(tr("Connected tab count: %1").arg(tabWidget->count()));
     appendLog(tr("Closed room tab %1").arg(index + 1));
 }
 
+void LiveKitWindow::setTracingEnabled(bool enabled) {
+    SessionTrace::setEnabled(enabled);
+    for (int i = 0; i < tabWidget->count(); ++i) {
+        if (auto *roomWidget = qobject_cast<LiveKitRoomWidget *>(tabWidget->widget(i))) {
+            roomWidget->setTracingEnabled(enabled);
+        }
+    }
+    appendLog(enabled ? tr("Join tracing enabled") : tr("Join tracing disabled"));
+}
+
+void LiveKitWindow::exportTrace() {
+    const QString path = QFileDialog::getSaveFileName(this, tr("Export trace"), QStringLiteral("vagabond-trace.json"),
+                                                      tr("Chrome trace (*.json)"));
+    if (path.isEmpty()) return;
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        appendLog(tr("Could not write trace: %1").arg(file.errorString()));
+        return;
+    }
+    file.write(SessionTrace::exportChromeJson());
+    appendLog(tr("Trace written to %1 (open in chrome://tracing or Perfetto)").arg(path));
+}
+
 void LiveKitWindow::appendLog(const QString &line) {
     statusLabel->setText(line);
 }
@@ -202,7 +425,8 @@ void LiveKitWindow::setFormEnabled(bool enabled) {
     roomInput->setEnabled(enabled);
     connectButton->setEnabled(enabled);
     audioCheck->setEnabled(enabled);
-    videoCheck->setEnabled(enabled);
+    videoCheck->setEnabled(enabled && !voiceCheck->isChecked());
+    voiceCheck->setEnabled(enabled);
 }
 
 QUrl LiveKitWindow::authEndpoint() const {
@@ -215,11 +439,67 @@ QUrl LiveKitWindow::authEndpoint() const {
 }
 
 void LiveKitWindow::openRoomTab(const QString &url, const QString &token, const QString &room,
-                                bool startWithAudio, bool startWithVideo) {
+                                bool startWithAudio, bool startWithVideo, bool voiceOnly) {
+    SessionTrace::Span openSpan("room.tab.open", "ui", room, pendingTraceSession);
     const QString label = room.isEmpty() ? QStringLiteral("Room") : room;
-    auto *roomWidget = new LiveKitRoomWidget(url, token, label, startWithAudio, startWithVideo,
-                                             sdkUrlInput->text().trimmed(), this);
+    auto *roomWidget = new LiveKitRoomWidget(url, token, label, startWithAudio, startWithVideo, voiceOnly,
+                                             sdkUrlInput->text().trimmed(), pendingTraceSession, this);
+    connect(roomWidget, &LiveKitRoomWidget::encoderLoadReported, this,
+            [this, roomWidget](double encodeMsPerSec, int level) {
+                handleEncoderLoad(roomWidget, encodeMsPerSec, level);
+            });
     const int idx = tabWidget->addTab(roomWidget, label);
     tabWidget->setCurrentIndex(idx);
     statusLabel->setText(tr("Connected tab count: %1").arg(tabWidget->count()));
 }
+
+void LiveKitWindow::handleEncoderLoad(LiveKitRoomWidget *roomWidget, double encodeMsPerSec, int level) {
+    EncoderLoad &load = encoderLoads[roomWidget];
+    load.encodeMsPerSec = encodeMsPerSec;
+    load.level = level;
+
+    if (lastRebalance.isValid() && lastRebalance.elapsed() < kRebalanceIntervalMs) return;
+    lastRebalance.start();
+    rebalanceEncoderBudget();
+}
+
+void LiveKitWindow::rebalanceEncoderBudget() {
+    double total = 0;
+    for (const EncoderLoad &load : std::as_const(encoderLoads)) {
+        total += load.encodeMsPerSec;
+    }
+
+    // One step per interval: over budget, cap the heaviest camera; well under budget, relax
+    // the most restricted one. Each page still steps down on its own when locally limited.
+    LiveKitRoomWidget *target = nullptr;
+    int ceiling = 0;
+    if (total > encodeBudgetMs) {
+        double heaviest = 0;
+        for (auto it = encoderLoads.cbegin(); it != encoderLoads.cend(); ++it) {
+            const int next = std::max(it->ceiling, it->level) + 1;
+            if (next <= kLowestQualityLevel && it->encodeMsPerSec > heaviest) {
+                heaviest = it->encodeMsPerSec;
+                target = it.key();
+                ceiling = next;
+            }
+        }
+    } else if (total < encodeBudgetMs * 0.6) {
+        int mostRestricted = 0;
+        for (auto it = encoderLoads.cbegin(); it != encoderLoads.cend(); ++it) {
+            if (it->ceiling > mostRestricted) {
+                mostRestricted = it->ceiling;
+                target = it.key();
+                ceiling = it->ceiling - 1;
+            }
+        }
+    }
+
+    if (!target) return;
+    encoderLoads[target].ceiling = ceiling;
+    target->setQualityCeiling(ceiling);
+    appendLog(tr("Encoder load %1 ms/s (budget %2): %3 camera capped at level %4")
+                  .arg(total, 0, 'f', 0)
+                  .arg(encodeBudgetMs, 0, 'f', 0)
+                  .arg(target->title())
+                  .arg(ceiling));
+}
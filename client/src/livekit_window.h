@@ -1,6 +1,8 @@
 #pragma once
 
 #include <QCheckBox>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QLabel>
 #include <QLineEdit>
 #include <QMainWindow>
@@ -8,23 +10,53 @@
 #include <QNetworkReply>
 #include <QPushButton>
 #include <QTabWidget>
+#include <QTimer>
+#include <cstdint>
+
+class LiveKitRoomWidget;
 
 class LiveKitWindow : public QMainWindow {
     Q_OBJECT
 public:
     explicit LiveKitWindow(QWidget *parent = nullptr);
 
+    // Arguments from this or a later launch; `vagabond://room/<name>` opens or focuses that room.
+    // sentAtMs is the forwarding process' wall clock, or 0 for our own command line.
+    void handleLaunchRequest(const QStringList &arguments, double sentAtMs);
+    // When off, a successful sign-in stops at roomTokenReceived without creating the room tab.
+    void setOpensRoomTabs(bool opens) { opensRoomTabs = opens; }
+
+signals:
+    // Emitted once per sign-in after retries are exhausted or the token arrived.
+    void authFinished(bool succeeded);
+    void roomTokenReceived(const QString &url, const QString &token, const QString &room);
+    // Emitted after a launch request was processed; forwardLatencyMs is 0 for our own command line.
+    void launchRequestHandled(double forwardLatencyMs);
+
 private slots:
     void connectToLiveKit();
     void handleAuthResponse();
+    void sendAuthRequest();
     void closeTab(int index);
+    void setTracingEnabled(bool enabled);
+    void exportTrace();
+    void openQueuedLaunchRoom();
 
 private:
+    void openRoomLink(const QString &room);
     void appendLog(const QString &line);
     void setFormEnabled(bool enabled);
     QUrl authEndpoint() const;
     void openRoomTab(const QString &url, const QString &token, const QString &room,
-                     bool startWithAudio, bool startWithVideo);
+                     bool startWithAudio, bool startWithVideo, bool voiceOnly);
+    void handleEncoderLoad(LiveKitRoomWidget *roomWidget, double encodeMsPerSec, int level);
+    void rebalanceEncoderBudget();
+
+    struct EncoderLoad {
+        double encodeMsPerSec {0};
+        int level {0};
+        int ceiling {0};
+    };
 
     QLineEdit *authUrlInput {nullptr};
     QLineEdit *sdkUrlInput {nullptr};
@@ -33,11 +65,31 @@ private:
     QLineEdit *roomInput {nullptr};
     QCheckBox *audioCheck {nullptr};
     QCheckBox *videoCheck {nullptr};
+    QCheckBox *voiceCheck {nullptr};
+    QCheckBox *traceCheck {nullptr};
     QPushButton *connectButton {nullptr};
+    QPushButton *exportTraceButton {nullptr};
     QLabel *statusLabel {nullptr};
     QLabel *accountLabel {nullptr};
     QTabWidget *tabWidget {nullptr};
     QNetworkAccessManager network;
     QNetworkReply *pendingAuthReply {nullptr};
+    QNetworkRequest pendingAuthRequest;
+    QByteArray pendingAuthPayload;
+    int authAttempt {0};
+    bool authReplyOversized {false};
+    bool authReplyTimedOut {false};
+    int authTimeoutMs {0};
+    int authDeadlineMs {0};
+    QTimer authRetryTimer;
+    QTimer authDeadlineTimer;
     QString lastIdentity;
+    QString pendingRoom;
+    QString queuedLaunchRoom;
+    std::uint32_t pendingTraceSession {0};
+    std::uint64_t authStartNs {0};
+    QHash<LiveKitRoomWidget *, EncoderLoad> encoderLoads;
+    double encodeBudgetMs {350.0};
+    QElapsedTimer lastRebalance;
+    bool opensRoomTabs {true};
 };
@@ -1,9 +1,29 @@
 #include <QApplication>
+#include <QDir>
+#include <QLocalServer>
+#include <QLockFile>
 #include "livekit_window.h"
+#include "single_instance.h"
 
 int main(int argc, char *argv[]) {
     QApplication app(argc, argv);
+    const QStringList launchArguments = app.arguments().mid(1);
+
+    QLockFile instanceLock(QDir::temp().filePath(SingleInstance::serverName() + QStringLiteral(".lock")));
+    bool forwarded = false;
+    const bool primary = SingleInstance::acquirePrimaryRole(instanceLock, launchArguments, forwarded);
+    if (forwarded) {
+        return 0;
+    }
+
     LiveKitWindow window;
+    QLocalServer instanceServer;
+    if (primary) {
+        SingleInstance::listenForLaunches(instanceServer, window);
+    } else {
+        qWarning("Another client holds the instance lock but is not accepting launches; running standalone");
+    }
     window.show();
+    window.handleLaunchRequest(launchArguments, 0);
     return app.exec();
 }
@@ -0,0 +1,220 @@
+#include "session_trace.h"
+
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> SessionTrace::enabledFlag {false};
+std::atomic<std::uint32_t> SessionTrace::nextSession {1};
+
+namespace {
+
+constexpr std::size_t kRingCapacity = 2048;
+constexpr int kClientPid = 1;
+constexpr int kFirstSessionPid = 100;
+constexpr int kPageTid = 1000;
+
+struct TraceEvent {
+    char name[128];
+    char category[24];
+    char room[64];
+    std::uint64_t startNs;
+    std::uint64_t durationNs;
+    std::uint32_t session;
+    bool fromPage;
+};
+
+// Only the owning thread writes; readers snapshot up to `head` and drop any
+// slot the writer may have lapped while they were copying.
+struct ThreadBuffer {
+    std::atomic<std::uint64_t> head {0};
+    TraceEvent events[kRingCapacity];
+    int tid {0};
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<ThreadBuffer *> buffers;
+};
+
+Registry &registry() {
+    static Registry instance;
+    return instance;
+}
+
+ThreadBuffer *threadBuffer() {
+    // Buffers are intentionally leaked so spans from finished threads survive until export.
+    thread_local ThreadBuffer *buffer = [] {
+        auto *created = new ThreadBuffer;
+        Registry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        created->tid = static_cast<int>(reg.buffers.size()) + 1;
+        reg.buffers.push_back(created);
+        return created;
+    }();
+    return buffer;
+}
+
+struct ClockAnchor {
+    std::uint64_t steadyNs;
+    std::uint64_t epochNs;
+};
+
+const ClockAnchor &clockAnchor() {
+    static const ClockAnchor anchor = [] {
+        ClockAnchor a;
+        a.steadyNs = SessionTrace::nowNs();
+        a.epochNs = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                   std::chrono::system_clock::now().time_since_epoch())
+                                                   .count());
+        return a;
+    }();
+    return anchor;
+}
+
+void copyField(char *dest, std::size_t size, const QByteArray &value) {
+    const std::size_t length = std::min(size - 1, static_cast<std::size_t>(value.size()));
+    std::memcpy(dest, value.constData(), length);
+    dest[length] = '\0';
+}
+
+void push(const QByteArray &name, const QByteArray &category, std::uint64_t startNs, std::uint64_t endNs,
+          const QByteArray &room, std::uint32_t session, bool fromPage) {
+    ThreadBuffer *buffer = threadBuffer();
+    const std::uint64_t index = buffer->head.load(std::memory_order_relaxed);
+    TraceEvent &event = buffer->events[index % kRingCapacity];
+    copyField(event.name, sizeof(event.name), name);
+    copyField(event.category, sizeof(event.category), category);
+    copyField(event.room, sizeof(event.room), room);
+    event.startNs = startNs;
+    event.durationNs = endNs > startNs ? endNs - startNs : 0;
+    event.session = session;
+    event.fromPage = fromPage;
+    buffer->head.store(index + 1, std::memory_order_release);
+}
+
+double toTraceMicros(std::uint64_t steadyNs) {
+    const ClockAnchor &anchor = clockAnchor();
+    const double offsetNs = static_cast<double>(steadyNs) - static_cast<double>(anchor.steadyNs);
+    return (static_cast<double>(anchor.epochNs) + offsetNs) / 1000.0;
+}
+
+QJsonObject metadataEvent(const QString &kind, int pid, int tid, const QString &name) {
+    QJsonObject args;
+    args.insert(QStringLiteral("name"), name);
+    QJsonObject event;
+    event.insert(QStringLiteral("ph"), QStringLiteral("M"));
+    event.insert(QStringLiteral("name"), kind);
+    event.insert(QStringLiteral("pid"), pid);
+    event.insert(QStringLiteral("tid"), tid);
+    event.insert(QStringLiteral("args"), args);
+    return event;
+}
+
+} // namespace
+
+void SessionTrace::setEnabled(bool enabled) {
+    clockAnchor();
+    enabledFlag.store(enabled, std::memory_order_relaxed);
+}
+
+std::uint64_t SessionTrace::fromEpochMs(double epochMs) {
+    const ClockAnchor &anchor = clockAnchor();
+    const double epochNs = epochMs * 1000000.0;
+    const double steadyNs = static_cast<double>(anchor.steadyNs) + (epochNs - static_cast<double>(anchor.epochNs));
+    return steadyNs > 0 ? static_cast<std::uint64_t>(steadyNs) : 0;
+}
+
+void SessionTrace::record(const char *name, const char *category, std::uint64_t startNs, std::uint64_t endNs,
+                          const QString &room, std::uint32_t session) {
+    if (!isEnabled()) return;
+    push(QByteArray::fromRawData(name, static_cast<int>(std::strlen(name))),
+         QByteArray::fromRawData(category, static_cast<int>(std::strlen(category))), startNs, endNs,
+         room.toUtf8(), session, false);
+}
+
+void SessionTrace::recordPage(const QString &name, const QString &category, std::uint64_t startNs,
+                              std::uint64_t endNs, const QString &room, std::uint32_t session) {
+    if (!isEnabled()) return;
+    push(name.toUtf8(), category.toUtf8(), startNs, endNs, room.toUtf8(), session, true);
+}
+
+QByteArray SessionTrace::exportChromeJson() {
+    std::vector<std::pair<int, std::vector<TraceEvent>>> snapshots;
+    {
+        Registry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (ThreadBuffer *buffer : reg.buffers) {
+            const std::uint64_t head = buffer->head.load(std::memory_order_acquire);
+            const std::uint64_t first = head > kRingCapacity ? head - kRingCapacity : 0;
+            std::vector<TraceEvent> copied;
+            copied.reserve(static_cast<std::size_t>(head - first));
+            for (std::uint64_t i = first; i < head; ++i) {
+                copied.push_back(buffer->events[i % kRingCapacity]);
+            }
+            // Anything at or below the writer's current lap may have been overwritten mid-copy.
+            const std::uint64_t headAfter = buffer->head.load(std::memory_order_acquire);
+            const std::uint64_t stable = headAfter >= kRingCapacity ? headAfter - kRingCapacity + 1 : 0;
+            if (stable > first) {
+                copied.erase(copied.begin(),
+                             copied.begin() + static_cast<std::ptrdiff_t>(std::min(stable - first, head - first)));
+            }
+            snapshots.emplace_back(buffer->tid, std::move(copied));
+        }
+    }
+
+    QJsonArray events;
+    events.append(metadataEvent(QStringLiteral("process_name"), kClientPid, 0, QStringLiteral("Vagabond client")));
+
+    // Each join session gets its own lane holding both the client-side auth spans and the
+    // page spans of the tab it opened, so two tabs for the same room never share a track.
+    QHash<std::uint32_t, int> sessionPids;
+    for (const auto &snapshot : snapshots) {
+        for (const TraceEvent &source : snapshot.second) {
+            const QString room = QString::fromUtf8(source.room);
+            int pid = kClientPid;
+            int tid = source.fromPage ? kPageTid : snapshot.first;
+            if (source.session) {
+                auto it = sessionPids.find(source.session);
+                if (it == sessionPids.end()) {
+                    it = sessionPids.insert(source.session, kFirstSessionPid + static_cast<int>(source.session));
+                    events.append(metadataEvent(QStringLiteral("process_name"), it.value(), 0,
+                                                QStringLiteral("Join %1 (%2)").arg(source.session).arg(room)));
+                    events.append(metadataEvent(QStringLiteral("thread_name"), it.value(), kPageTid,
+                                                QStringLiteral("room page")));
+                }
+                pid = it.value();
+            }
+
+            QJsonObject args;
+            if (!room.isEmpty()) {
+                args.insert(QStringLiteral("room"), room);
+            }
+            if (source.session) {
+                args.insert(QStringLiteral("session"), static_cast<int>(source.session));
+            }
+
+            QJsonObject event;
+            event.insert(QStringLiteral("name"), QString::fromUtf8(source.name));
+            event.insert(QStringLiteral("cat"), QString::fromUtf8(source.category));
+            event.insert(QStringLiteral("ph"), QStringLiteral("X"));
+            event.insert(QStringLiteral("ts"), toTraceMicros(source.startNs));
+            event.insert(QStringLiteral("dur"), static_cast<double>(source.durationNs) / 1000.0);
+            event.insert(QStringLiteral("pid"), pid);
+            event.insert(QStringLiteral("tid"), tid);
+            event.insert(QStringLiteral("args"), args);
+            events.append(event);
+        }
+    }
+
+    QJsonObject root;
+    root.insert(QStringLiteral("traceEvents"), events);
+    root.insert(QStringLiteral("displayTimeUnit"), QStringLiteral("ms"));
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Lightweight span recorder for join/session diagnostics. Spans land in a
+// per-thread ring buffer (single writer, no locks on the hot path) and can be
+// exported as Chrome trace_event JSON for chrome://tracing or Perfetto.
+class SessionTrace {
+public:
+    static bool isEnabled() { return enabledFlag.load(std::memory_order_relaxed); }
+    static void setEnabled(bool enabled);
+
+    static std::uint64_t nowNs() {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                              std::chrono::steady_clock::now().time_since_epoch())
+                                              .count());
+    }
+
+    // Converts a wall-clock timestamp (ms since the Unix epoch, as reported by
+    // performance.timeOrigin + performance.now() in the page) onto nowNs().
+    static std::uint64_t fromEpochMs(double epochMs);
+
+    // Identifies one join attempt end to end: its auth spans and the spans of the
+    // room tab it opens share the id and land in the same lane of the export.
+    static std::uint32_t newSession() { return nextSession.fetch_add(1, std::memory_order_relaxed); }
+
+    static void record(const char *name, const char *category, std::uint64_t startNs, std::uint64_t endNs,
+                       const QString &room = QString(), std::uint32_t session = 0);
+    static void recordPage(const QString &name, const QString &category, std::uint64_t startNs,
+                           std::uint64_t endNs, const QString &room, std::uint32_t session);
+
+    static QByteArray exportChromeJson();
+
+    class Span {
+    public:
+        Span(const char *name, const char *category, const QString &room = QString(), std::uint32_t session = 0)
+            : spanName(name), spanCategory(category), spanRoom(room), spanSession(session),
+              startNs(SessionTrace::isEnabled() ? SessionTrace::nowNs() : 0) {}
+        ~Span() {
+            if (startNs) {
+                SessionTrace::record(spanName, spanCategory, startNs, SessionTrace::nowNs(), spanRoom, spanSession);
+            }
+        }
+        Span(const Span &) = delete;
+        Span &operator=(const Span &) = delete;
+
+    private:
+        const char *spanName;
+        const char *spanCategory;
+        QString spanRoom;
+        std::uint32_t spanSession;
+        std::uint64_t startNs;
+    };
+
+private:
+    static std::atomic<bool> enabledFlag;
+    static std::atomic<std::uint32_t> nextSession;
+};
@@ -0,0 +1,70 @@
+#include "single_instance.h"
+
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalSocket>
+#include "livekit_window.h"
+
+QString SingleInstance::serverName() {
+    QString user = qEnvironmentVariable("USER");
+    if (user.isEmpty()) {
+        user = qEnvironmentVariable("USERNAME");
+    }
+    return QStringLiteral("vagabond-client-%1").arg(user);
+}
+
+bool SingleInstance::forwardToRunningInstance(const QStringList &arguments, const QString &name) {
+    QLocalSocket socket;
+    socket.connectToServer(name);
+    if (!socket.waitForConnected(200)) return false;
+
+    QJsonObject message;
+    message.insert(QStringLiteral("args"), QJsonArray::fromStringList(arguments));
+    message.insert(QStringLiteral("sentAtMs"), static_cast<double>(QDateTime::currentMSecsSinceEpoch()));
+    socket.write(QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n');
+    socket.waitForBytesWritten(500);
+    socket.disconnectFromServer();
+    return true;
+}
+
+bool SingleInstance::acquirePrimaryRole(QLockFile &lock, const QStringList &arguments, bool &forwarded) {
+    lock.setStaleLockTime(0);
+    for (int attempt = 0; attempt < 20; ++attempt) {
+        if (forwardToRunningInstance(arguments)) {
+            forwarded = true;
+            return false;
+        }
+        if (lock.tryLock(100)) return true;
+    }
+    return false;
+}
+
+bool SingleInstance::listenForLaunches(QLocalServer &server, LiveKitWindow &window, const QString &name) {
+    server.setSocketOptions(QLocalServer::UserAccessOption);
+    if (!server.listen(name)) {
+        // We hold the instance lock, so whatever owns this name is a crashed instance's socket.
+        QLocalServer::removeServer(name);
+        if (!server.listen(name)) {
+            qWarning("Single-instance server unavailable: %s", qPrintable(server.errorString()));
+            return false;
+        }
+    }
+
+    QObject::connect(&server, &QLocalServer::newConnection, &window, [&server, &window]() {
+        while (QLocalSocket *socket = server.nextPendingConnection()) {
+            QObject::connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+            QObject::connect(socket, &QLocalSocket::readyRead, &window, [socket, &window]() {
+                if (!socket->canReadLine()) return;
+                const QJsonObject message = QJsonDocument::fromJson(socket->readLine()).object();
+                QStringList arguments;
+                for (const QJsonValue &value : message.value(QStringLiteral("args")).toArray()) {
+                    arguments.append(value.toString());
+                }
+                window.handleLaunchRequest(arguments, message.value(QStringLiteral("sentAtMs")).toDouble());
+            });
+        }
+    });
+    return true;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <QLocalServer>
+#include <QLockFile>
+#include <QString>
+#include <QStringList>
+
+class LiveKitWindow;
+
+// One client per user: later launches hand their command line to the running
+// window over a QLocalSocket instead of starting another browser stack.
+class SingleInstance {
+public:
+    static QString serverName();
+
+    // Hands our arguments to an already running client. Returns false when none is listening.
+    static bool forwardToRunningInstance(const QStringList &arguments, const QString &name = serverName());
+
+    // Only the holder of this lock may listen, so a slow or racing launch can never take over a
+    // live primary's socket. QLockFile detects a lock left behind by a crashed process.
+    static bool acquirePrimaryRole(QLockFile &lock, const QStringList &arguments, bool &forwarded);
+
+    static bool listenForLaunches(QLocalServer &server, LiveKitWindow &window, const QString &name = serverName());
+};
@@ -0,0 +1,337 @@
+#include <QElapsedTimer>
+#include <QLabel>
+#include <QLineEdit>
+#include <QSignalSpy>
+#include <QtTest>
+#include <memory>
+#include "livekit_window.h"
+#include "token_stand_in_server.h"
+
+namespace {
+
+constexpr int kTestAuthTimeoutMs = 1000;
+// Three attempts, each bounded by the 1.5x deadline, plus the 0.5 s and 1 s backoffs.
+constexpr int kWorstCaseSignInMs = 3 * kTestAuthTimeoutMs * 3 / 2 + 1500 + 2000;
+// Mirrors the client's auth response cap.
+constexpr qsizetype kMaxAuthResponseBytes = 1024 * 1024;
+
+using Response = TokenStandInServer::Response;
+
+} // namespace
+
+// Drives LiveKitWindow's real sign-in path against the in-process token server
+// and checks each response shape and fault the auth backend can produce.
+class AuthContractTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void prefersLivekitUrlAndRoomName();
+    void fallsBackToUrlAndRoom();
+    void fallsBackToDefaultHostAndRequestedRoom();
+    void rejectsMissingToken();
+    void rejectsMalformedJson();
+    void reportsClientErrorWithoutRetry();
+    void retriesTransientServerErrors();
+    void givesUpAfterThreeAttempts();
+    void timesOutSilentServer();
+    void abortsDrippingServer();
+    void abortsOversizedBody();
+    void acceptsChunkedToken();
+    void abortsOversizedChunkedBody();
+    void acceptsBodyJustUnderCap_data();
+    void acceptsBodyJustUnderCap();
+    void toleratesSlowServer();
+    void benchmarkSignIn();
+
+private:
+    bool signIn(qint64 *elapsedMs = nullptr);
+    QString statusText() const;
+    bool formEnabled() const;
+
+    std::unique_ptr<TokenStandInServer> server;
+    std::unique_ptr<LiveKitWindow> window;
+    QString receivedUrl;
+    QString receivedToken;
+    QString receivedRoom;
+};
+
+void AuthContractTest::initTestCase() {
+    qputenv("VAGABOND_AUTH_TIMEOUT_MS", QByteArray::number(kTestAuthTimeoutMs));
+}
+
+void AuthContractTest::init() {
+    server = std::make_unique<TokenStandInServer>();
+    QVERIFY(server->start());
+
+    window = std::make_unique<LiveKitWindow>();
+    // Stop at the token so no test starts Chromium or reaches a real LiveKit host.
+    window->setOpensRoomTabs(false);
+    window->findChild<QLineEdit *>(QStringLiteral("authUrlInput"))->setText(server->endpoint().toString());
+    window->findChild<QLineEdit *>(QStringLiteral("roomInput"))->setText(QStringLiteral("general"));
+
+    receivedUrl.clear();
+    receivedToken.clear();
+    receivedRoom.clear();
+    connect(window.get(), &LiveKitWindow::roomTokenReceived, this,
+            [this](const QString &url, const QString &token, const QString &room) {
+                receivedUrl = url;
+                receivedToken = token;
+                receivedRoom = room;
+            });
+}
+
+void AuthContractTest::cleanup() {
+    window.reset();
+    server.reset();
+}
+
+bool AuthContractTest::signIn(qint64 *elapsedMs) {
+    QSignalSpy finished(window.get(), &LiveKitWindow::authFinished);
+    QElapsedTimer timer;
+    timer.start();
+    QMetaObject::invokeMethod(window.get(), "connectToLiveKit");
+    if (finished.isEmpty() && !finished.wait(kWorstCaseSignInMs)) {
+        qWarning("sign-in did not finish within %d ms", kWorstCaseSignInMs);
+        return false;
+    }
+    const qint64 elapsed = timer.elapsed();
+    qInfo("%s: auth handled in %lld ms after %d request(s)", QTest::currentTestFunction(), elapsed,
+          server->requestCount());
+    if (elapsedMs) {
+        *elapsedMs = elapsed;
+    }
+    return finished.first().first().toBool();
+}
+
+QString AuthContractTest::statusText() const {
+    return window->findChild<QLabel *>(QStringLiteral("statusLabel"))->text();
+}
+
+bool AuthContractTest::formEnabled() const {
+    return window->findChild<QLineEdit *>(QStringLiteral("authUrlInput"))->isEnabled();
+}
+
+void AuthContractTest::prefersLivekitUrlAndRoomName() {
+    Response response;
+    response.fields.insert(QStringLiteral("livekitUrl"), QStringLiteral("wss://primary.example"));
+    response.fields.insert(QStringLiteral("url"), QStringLiteral("wss://secondary.example"));
+    response.fields.insert(QStringLiteral("roomName"), QStringLiteral("assigned"));
+    response.fields.insert(QStringLiteral("room"), QStringLiteral("legacy"));
+    server->setResponses({response});
+
+    QVERIFY(signIn());
+    QCOMPARE(receivedUrl, QStringLiteral("wss://primary.example"));
+    QCOMPARE(receivedRoom, QStringLiteral("assigned"));
+
+    const QJsonObject request = server->lastRequest();
+    QCOMPARE(request.value(QStringLiteral("identity")).toString(), QStringLiteral("test"));
+    QCOMPARE(request.value(QStringLiteral("roomName")).toString(), QStringLiteral("general"));
+    QCOMPARE(request.value(QStringLiteral("room")).toString(), QStringLiteral("general"));
+
+    QJsonObject claims;
+    QVERIFY(TokenStandInServer::verifyToken(receivedToken.toLatin1(), &claims));
+    QCOMPARE(claims.value(QStringLiteral("iss")).toString(), TokenStandInServer::apiKey);
+    QCOMPARE(claims.value(QStringLiteral("sub")).toString(), QStringLiteral("test"));
+    QCOMPARE(claims.value(QStringLiteral("video")).toObject().value(QStringLiteral("room")).toString(),
+             QStringLiteral("general"));
+}
+
+void AuthContractTest::fallsBackToUrlAndRoom() {
+    Response response;
+    response.fields.insert(QStringLiteral("url"), QStringLiteral("wss://secondary.example"));
+    response.fields.insert(QStringLiteral("room"), QStringLiteral("legacy"));
+    server->setResponses({response});
+
+    QVERIFY(signIn());
+    QCOMPARE(receivedUrl, QStringLiteral("wss://secondary.example"));
+    QCOMPARE(receivedRoom, QStringLiteral("legacy"));
+}
+
+void AuthContractTest::fallsBackToDefaultHostAndRequestedRoom() {
+    server->setResponses({Response()});
+
+    QVERIFY(signIn());
+    QCOMPARE(receivedUrl, QStringLiteral("wss://livekit.vagabovnr.moscow"));
+    QCOMPARE(receivedRoom, QStringLiteral("general"));
+    QVERIFY(TokenStandInServer::verifyToken(receivedToken.toLatin1()));
+}
+
+void AuthContractTest::rejectsMissingToken() {
+    Response response;
+    response.withToken = false;
+    response.fields.insert(QStringLiteral("livekitUrl"), QStringLiteral("wss://primary.example"));
+    server->setResponses({response});
+
+    QVERIFY(!signIn());
+    QVERIFY(statusText().contains(QStringLiteral("token"), Qt::CaseInsensitive));
+    QVERIFY(receivedToken.isEmpty());
+    QVERIFY(formEnabled());
+}
+
+void AuthContractTest::rejectsMalformedJson() {
+    Response response;
+    response.rawBody = QByteArrayLiteral("{\"token\": \"abc\", ");
+    server->setResponses({response});
+
+    QVERIFY(!signIn());
+    QVERIFY(statusText().contains(QStringLiteral("Unexpected response")));
+    QCOMPARE(server->requestCount(), 1);
+    QVERIFY(formEnabled());
+}
+
+void AuthContractTest::reportsClientErrorWithoutRetry() {
+    Response response;
+    response.status = 401;
+    response.rawBody = QByteArrayLiteral("{\"error\":\"bad password\"}");
+    server->setResponses({response});
+
+    QVERIFY(!signIn());
+    QVERIFY(statusText().contains(QStringLiteral("HTTP 401")));
+    QVERIFY(statusText().contains(QStringLiteral("bad password")));
+    QCOMPARE(server->requestCount(), 1);
+    QVERIFY(formEnabled());
+}
+
+void AuthContractTest::retriesTransientServerErrors() {
+    Response unavailable;
+    unavailable.status = 503;
+    unavailable.rawBody = QByteArrayLiteral("{\"error\":\"warming up\"}");
+    Response badGateway = unavailable;
+    badGateway.status = 502;
+    server->setResponses({unavailable, badGateway, Response()});
+
+    QVERIFY(signIn());
+    QCOMPARE(server->requestCount(), 3);
+    QVERIFY(TokenStandInServer::verifyToken(receivedToken.toLatin1()));
+}
+
+void AuthContractTest::givesUpAfterThreeAttempts() {
+    Response unavailable;
+    unavailable.status = 503;
+    unavailable.rawBody = QByteArrayLiteral("{\"error\":\"down\"}");
+    server->setResponses({unavailable});
+
+    QVERIFY(!signIn());
+    QCOMPARE(server->requestCount(), 3);
+    QVERIFY(statusText().contains(QStringLiteral("HTTP 503")));
+    QVERIFY(formEnabled());
+}
+
+void AuthContractTest::timesOutSilentServer() {
+    Response silent;
+    silent.delivery = TokenStandInServer::Delivery::Hang;
+    server->setResponses({silent});
+
+    qint64 elapsed = 0;
+    QVERIFY(!signIn(&elapsed));
+    QCOMPARE(server->requestCount(), 3);
+    QVERIFY(statusText().contains(QStringLiteral("no data received")));
+    QVERIFY(elapsed >= 3 * kTestAuthTimeoutMs);
+    QVERIFY(formEnabled());
+}
+
+void AuthContractTest::abortsDrippingServer() {
+    // One byte every 50 ms never trips the transfer timeout, only the overall deadline.
+    Response drip;
+    drip.delivery = TokenStandInServer::Delivery::Drip;
+    drip.dripIntervalMs = 50;
+    drip.rawBody = QByteArray(4096, ' ') + "{}";
+    server->setResponses({drip});
+
+    qint64 elapsed = 0;
+    QVERIFY(!signIn(&elapsed));
+    QCOMPARE(server->requestCount(), 3);
+    QVERIFY(statusText().contains(QStringLiteral("not complete")));
+    QVERIFY(elapsed < kWorstCaseSignInMs);
+    QVERIFY(formEnabled());
+}
+
+void AuthContractTest::abortsOversizedBody() {
+    Response huge;
+    huge.rawBody = "{\"token\":\"" + QByteArray(2 * 1024 * 1024, 'x') + "\"}";
+    server->setResponses({huge});
+
+    QVERIFY(!signIn());
+    QCOMPARE(server->requestCount(), 1);
+    QVERIFY(statusText().contains(QStringLiteral("exceeded")));
+    QVERIFY(receivedToken.isEmpty());
+    QVERIFY(formEnabled());
+}
+
+void AuthContractTest::acceptsChunkedToken() {
+    Response chunked;
+    chunked.delivery = TokenStandInServer::Delivery::Chunked;
+    chunked.chunkBytes = 7;
+    chunked.fields.insert(QStringLiteral("livekitUrl"), QStringLiteral("wss://primary.example"));
+    server->setResponses({chunked});
+
+    QVERIFY(signIn());
+    QCOMPARE(server->requestCount(), 1);
+    QCOMPARE(receivedUrl, QStringLiteral("wss://primary.example"));
+    QCOMPARE(receivedRoom, QStringLiteral("general"));
+    QVERIFY(TokenStandInServer::verifyToken(receivedToken.toLatin1()));
+}
+
+void AuthContractTest::abortsOversizedChunkedBody() {
+    // Without Content-Length only the running byte count can trip the cap.
+    Response huge;
+    huge.delivery = TokenStandInServer::Delivery::Chunked;
+    huge.rawBody = "{\"token\":\"" + QByteArray(2 * kMaxAuthResponseBytes, 'x') + "\"}";
+    server->setResponses({huge});
+
+    QVERIFY(!signIn());
+    QCOMPARE(server->requestCount(), 1);
+    QVERIFY(statusText().contains(QStringLiteral("exceeded")));
+    QVERIFY(receivedToken.isEmpty());
+    QVERIFY(formEnabled());
+}
+
+void AuthContractTest::acceptsBodyJustUnderCap_data() {
+    QTest::addColumn<TokenStandInServer::Delivery>("delivery");
+    QTest::newRow("content-length") << TokenStandInServer::Delivery::Normal;
+    QTest::newRow("chunked") << TokenStandInServer::Delivery::Chunked;
+}
+
+void AuthContractTest::acceptsBodyJustUnderCap() {
+    QFETCH(TokenStandInServer::Delivery, delivery);
+
+    const QByteArray token = TokenStandInServer::mintToken(QStringLiteral("test"), QStringLiteral("general"));
+    const QByteArray prefix = "{\"token\":\"" + token + "\",\"padding\":\"";
+    const QByteArray suffix = "\"}";
+    Response large;
+    large.delivery = delivery;
+    large.rawBody = prefix + QByteArray(kMaxAuthResponseBytes - 1 - prefix.size() - suffix.size(), 'x') + suffix;
+    QCOMPARE(large.rawBody.size(), kMaxAuthResponseBytes - 1);
+    server->setResponses({large});
+
+    QVERIFY(signIn());
+    QCOMPARE(server->requestCount(), 1);
+    QCOMPARE(receivedToken.toLatin1(), token);
+}
+
+void AuthContractTest::toleratesSlowServer() {
+    Response slow;
+    slow.latencyMs = kTestAuthTimeoutMs / 2;
+    server->setResponses({slow});
+
+    qint64 elapsed = 0;
+    QVERIFY(signIn(&elapsed));
+    QCOMPARE(server->requestCount(), 1);
+    QVERIFY(elapsed >= slow.latencyMs);
+}
+
+void AuthContractTest::benchmarkSignIn() {
+    // Request to roomTokenReceived only; no room tab is opened.
+    server->setResponses({Response()});
+
+    QBENCHMARK {
+        QVERIFY(signIn());
+    }
+}
+
+QTEST_MAIN(AuthContractTest)
+#include "auth_contract_test.moc"
@@ -0,0 +1,66 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QLineEdit>
+#include <QLocalServer>
+#include <QSignalSpy>
+#include <QtTest>
+#include <memory>
+#include "livekit_window.h"
+#include "single_instance.h"
+
+// Runs a primary window behind a QLocalServer in-process and measures how long a
+// second launch takes to hand over its arguments.
+class SingleInstanceTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void forwardsRoomLinkToPrimary();
+    void reportsMissingPrimary();
+    void benchmarkForwardLatency();
+
+private:
+    QString serverName;
+    std::unique_ptr<LiveKitWindow> window;
+    std::unique_ptr<QLocalServer> server;
+};
+
+void SingleInstanceTest::init() {
+    serverName = QStringLiteral("vagabond-test-%1").arg(QCoreApplication::applicationPid());
+    window = std::make_unique<LiveKitWindow>();
+    // A refused local port keeps the sign-in a forwarded room link triggers offline.
+    window->findChild<QLineEdit *>(QStringLiteral("authUrlInput"))->setText(QStringLiteral("http://127.0.0.1:1/api/token"));
+    server = std::make_unique<QLocalServer>();
+    QVERIFY(SingleInstance::listenForLaunches(*server, *window, serverName));
+}
+
+void SingleInstanceTest::cleanup() {
+    server.reset();
+    window.reset();
+}
+
+void SingleInstanceTest::forwardsRoomLinkToPrimary() {
+    QSignalSpy handled(window.get(), &LiveKitWindow::launchRequestHandled);
+    QVERIFY(SingleInstance::forwardToRunningInstance({QStringLiteral("vagabond://room/standup")}, serverName));
+    QVERIFY(handled.wait(2000));
+    QVERIFY(handled.first().first().toDouble() >= 0);
+    QCOMPARE(window->findChild<QLineEdit *>(QStringLiteral("roomInput"))->text(), QStringLiteral("standup"));
+}
+
+void SingleInstanceTest::reportsMissingPrimary() {
+    QVERIFY(!SingleInstance::forwardToRunningInstance({}, serverName + QStringLiteral("-missing")));
+}
+
+void SingleInstanceTest::benchmarkForwardLatency() {
+    // Times a second launch from connect/send until the primary's handleLaunchRequest runs.
+    QBENCHMARK {
+        QSignalSpy handled(window.get(), &LiveKitWindow::launchRequestHandled);
+        QVERIFY(SingleInstance::forwardToRunningInstance({QStringLiteral("--focus")}, serverName));
+        QVERIFY(!handled.isEmpty() || handled.wait(2000));
+    }
+}
+
+QTEST_MAIN(SingleInstanceTest)
+#include "single_instance_test.moc"
@@ -0,0 +1,201 @@
+#include "token_stand_in_server.h"
+
+#include <QDateTime>
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QMessageAuthenticationCode>
+#include <QTcpSocket>
+#include <QTimer>
+#include <algorithm>
+#include <memory>
+
+const QString TokenStandInServer::apiKey = QStringLiteral("APIstandin");
+const QByteArray TokenStandInServer::apiSecret = QByteArrayLiteral("stand-in-secret-with-at-least-32-bytes");
+
+namespace {
+
+QByteArray base64Url(const QByteArray &data) {
+    return data.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
+}
+
+QByteArray sign(const QByteArray &signingInput) {
+    return base64Url(QMessageAuthenticationCode::hash(signingInput, TokenStandInServer::apiSecret,
+                                                      QCryptographicHash::Sha256));
+}
+
+QByteArray reasonPhrase(int status) {
+    switch (status) {
+    case 200: return QByteArrayLiteral("OK");
+    case 400: return QByteArrayLiteral("Bad Request");
+    case 401: return QByteArrayLiteral("Unauthorized");
+    case 500: return QByteArrayLiteral("Internal Server Error");
+    case 502: return QByteArrayLiteral("Bad Gateway");
+    case 503: return QByteArrayLiteral("Service Unavailable");
+    case 504: return QByteArrayLiteral("Gateway Timeout");
+    default: return QByteArrayLiteral("Status");
+    }
+}
+
+} // namespace
+
+TokenStandInServer::TokenStandInServer(QObject *parent) : QObject(parent) {
+    connect(&server, &QTcpServer::newConnection, this, &TokenStandInServer::acceptConnections);
+}
+
+bool TokenStandInServer::start() {
+    return server.listen(QHostAddress::LocalHost, 0);
+}
+
+QUrl TokenStandInServer::endpoint() const {
+    return QUrl(QStringLiteral("http://127.0.0.1:%1/api/token").arg(server.serverPort()));
+}
+
+void TokenStandInServer::setResponses(const QList<Response> &scripted) {
+    responses = scripted;
+    served = 0;
+}
+
+QByteArray TokenStandInServer::mintToken(const QString &identity, const QString &room, qint64 ttlSeconds) {
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+
+    QJsonObject grant;
+    grant.insert(QStringLiteral("room"), room);
+    grant.insert(QStringLiteral("roomJoin"), true);
+    grant.insert(QStringLiteral("canPublish"), true);
+    grant.insert(QStringLiteral("canSubscribe"), true);
+    grant.insert(QStringLiteral("canPublishData"), true);
+
+    QJsonObject claims;
+    claims.insert(QStringLiteral("iss"), apiKey);
+    claims.insert(QStringLiteral("sub"), identity);
+    claims.insert(QStringLiteral("name"), identity);
+    claims.insert(QStringLiteral("nbf"), static_cast<double>(now));
+    claims.insert(QStringLiteral("exp"), static_cast<double>(now + ttlSeconds));
+    claims.insert(QStringLiteral("video"), grant);
+
+    QJsonObject header;
+    header.insert(QStringLiteral("alg"), QStringLiteral("HS256"));
+    header.insert(QStringLiteral("typ"), QStringLiteral("JWT"));
+
+    const QByteArray signingInput = base64Url(QJsonDocument(header).toJson(QJsonDocument::Compact)) + '.'
+                                    + base64Url(QJsonDocument(claims).toJson(QJsonDocument::Compact));
+    return signingInput + '.' + sign(signingInput);
+}
+
+bool TokenStandInServer::verifyToken(const QByteArray &token, QJsonObject *claims) {
+    const QList<QByteArray> parts = token.split('.');
+    if (parts.size() != 3) return false;
+    if (sign(parts[0] + '.' + parts[1]) != parts[2]) return false;
+
+    const QJsonObject decoded = QJsonDocument::fromJson(QByteArray::fromBase64(
+                                                            parts[1], QByteArray::Base64UrlEncoding))
+                                    .object();
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    if (decoded.value(QStringLiteral("exp")).toDouble() < now) return false;
+    if (claims) {
+        *claims = decoded;
+    }
+    return true;
+}
+
+void TokenStandInServer::acceptConnections() {
+    while (QTcpSocket *socket = server.nextPendingConnection()) {
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { readRequest(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            pendingRequests.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void TokenStandInServer::readRequest(QTcpSocket *socket) {
+    QByteArray &buffer = pendingRequests[socket];
+    buffer.append(socket->readAll());
+
+    const qsizetype headerEnd = buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) return;
+
+    qsizetype contentLength = 0;
+    const QList<QByteArray> headerLines = buffer.left(headerEnd).split('\n');
+    for (const QByteArray &line : headerLines) {
+        const qsizetype colon = line.indexOf(':');
+        if (colon > 0 && line.left(colon).trimmed().toLower() == "content-length") {
+            contentLength = line.mid(colon + 1).trimmed().toLongLong();
+        }
+    }
+
+    const QByteArray body = buffer.mid(headerEnd + 4);
+    if (body.size() < contentLength) return;
+
+    pendingRequests.remove(socket);
+    respond(socket, QJsonDocument::fromJson(body.left(contentLength)).object());
+}
+
+void TokenStandInServer::respond(QTcpSocket *socket, const QJsonObject &request) {
+    lastRequestBody = request;
+    const Response response = responses.isEmpty()
+                                  ? Response()
+                                  : responses.at(std::min<qsizetype>(served, responses.size() - 1));
+    ++served;
+
+    QByteArray body = response.rawBody;
+    if (body.isEmpty()) {
+        QJsonObject payload = response.fields;
+        if (response.withToken) {
+            const QString room = request.value(QStringLiteral("roomName"))
+                                     .toString(request.value(QStringLiteral("room")).toString());
+            payload.insert(QStringLiteral("token"),
+                           QString::fromLatin1(mintToken(request.value(QStringLiteral("identity")).toString(),
+                                                         room)));
+        }
+        body = QJsonDocument(payload).toJson(QJsonDocument::Compact);
+    }
+
+    if (response.delivery == Delivery::Hang) return;
+    if (response.latencyMs > 0) {
+        QTimer::singleShot(response.latencyMs, socket,
+                           [this, socket, response, body]() { deliver(socket, response, body); });
+        return;
+    }
+    deliver(socket, response, body);
+}
+
+void TokenStandInServer::deliver(QTcpSocket *socket, const Response &response, const QByteArray &body) {
+    const QByteArray statusLine = "HTTP/1.1 " + QByteArray::number(response.status) + ' '
+                                  + reasonPhrase(response.status) + "\r\nContent-Type: application/json\r\n";
+
+    if (response.delivery == Delivery::Chunked) {
+        // No Content-Length, so the client only learns the size as chunks arrive.
+        QByteArray out = statusLine + "Transfer-Encoding: chunked\r\nConnection: close\r\n\r\n";
+        const qsizetype step = std::max(1, response.chunkBytes);
+        for (qsizetype offset = 0; offset < body.size(); offset += step) {
+            const QByteArray chunk = body.mid(offset, step);
+            out += QByteArray::number(chunk.size(), 16) + "\r\n" + chunk + "\r\n";
+        }
+        socket->write(out + "0\r\n\r\n");
+        socket->disconnectFromHost();
+        return;
+    }
+
+    const QByteArray head = statusLine + "Content-Length: " + QByteArray::number(body.size())
+                            + "\r\nConnection: close\r\n\r\n";
+
+    if (response.delivery != Delivery::Drip) {
+        socket->write(head + body);
+        socket->disconnectFromHost();
+        return;
+    }
+
+    socket->write(head);
+    auto *timer = new QTimer(socket);
+    auto offset = std::make_shared<qsizetype>(0);
+    connect(timer, &QTimer::timeout, socket, [socket, timer, body, offset]() {
+        if (*offset >= body.size()) {
+            timer->stop();
+            socket->disconnectFromHost();
+            return;
+        }
+        socket->write(body.mid((*offset)++, 1));
+    });
+    timer->start(response.dripIntervalMs);
+}
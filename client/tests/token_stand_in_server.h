@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QTcpServer>
+#include <QUrl>
+
+class QTcpSocket;
+
+// In-process stand-in for the token backend. It answers POSTs with LiveKit
+// access tokens signed like the real server's (HS256 over the API secret) and
+// can inject latency, HTTP errors, malformed or oversized bodies, a server that
+// never answers, one that drips its body a byte at a time and one that sends it
+// with chunked transfer encoding (no Content-Length).
+class TokenStandInServer : public QObject {
+    Q_OBJECT
+public:
+    enum class Delivery { Normal, Hang, Drip, Chunked };
+    Q_ENUM(Delivery)
+
+    struct Response {
+        int status {200};
+        QJsonObject fields;
+        bool withToken {true};
+        QByteArray rawBody;
+        int latencyMs {0};
+        Delivery delivery {Delivery::Normal};
+        int dripIntervalMs {50};
+        int chunkBytes {16 * 1024};
+    };
+
+    static const QString apiKey;
+    static const QByteArray apiSecret;
+
+    explicit TokenStandInServer(QObject *parent = nullptr);
+
+    bool start();
+    QUrl endpoint() const;
+
+    // Served in order; the last entry repeats for any further request.
+    void setResponses(const QList<Response> &scripted);
+    int requestCount() const { return served; }
+    QJsonObject lastRequest() const { return lastRequestBody; }
+
+    static QByteArray mintToken(const QString &identity, const QString &room, qint64 ttlSeconds = 3600);
+    static bool verifyToken(const QByteArray &token, QJsonObject *claims = nullptr);
+
+private:
+    void acceptConnections();
+    void readRequest(QTcpSocket *socket);
+    void respond(QTcpSocket *socket, const QJsonObject &request);
+    void deliver(QTcpSocket *socket, const Response &response, const QByteArray &body);
+
+    QTcpServer server;
+    QList<Response> responses;
+    QHash<QTcpSocket *, QByteArray> pendingRequests;
+    QJsonObject lastRequestBody;
+    int served {0};
+};